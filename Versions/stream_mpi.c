@@ -51,6 +51,9 @@
 # include <string.h>
 # include <limits.h>
 # include <sys/time.h>
+#if defined(ENABLE_GATHER) || defined(ENABLE_SCATTER) || defined(ENABLE_INDIRECT_DOT_PRODUCT)
+# include <time.h>
+#endif
 # include "mpi.h"
 
 /*-----------------------------------------------------------------------
@@ -116,6 +119,21 @@
 #   define STREAM_ARRAY_SIZE	10000000
 #endif
 
+// The ENABLE_GATHER, ENABLE_SCATTER and ENABLE_INDIRECT_DOT_PRODUCT
+// kernels from stream.c are also available in this MPI version.  The
+// d[] and index arrays are distributed across the ranks in the same
+// way as a/b/c, each rank generates its own portion of the index
+// array, and the indices address the rank-local part of the arrays,
+// so the kernels measure local irregular-access bandwidth and MPI is
+// only used to synchronize the timers and gather the results.
+#ifndef STREAM_INDEX_ARRAY_SIZE
+#   define STREAM_INDEX_ARRAY_SIZE	10000000
+#endif
+
+#ifndef INDEX_TYPE
+#define INDEX_TYPE int
+#endif
+
 /*  2) STREAM runs each kernel "NTIMES" times and reports the *best* result
  *         for any iteration after the first, therefore the minimum value
  *         for NTIMES is 2.
@@ -209,6 +227,39 @@
 #define STREAM_TYPE double
 #endif
 
+#if defined(ENABLE_GATHER)
+#define NUM_KERNELS_GATHER 1
+#else
+#define NUM_KERNELS_GATHER 0
+#endif
+
+#if defined(ENABLE_SCATTER)
+#define NUM_KERNELS_SCATTER 1
+#else
+#define NUM_KERNELS_SCATTER 0
+#endif
+
+#if defined(ENABLE_INDIRECT_DOT_PRODUCT)
+#define NUM_KERNELS_INDIRECT_DOT_PRODUCT 1
+#else
+#define NUM_KERNELS_INDIRECT_DOT_PRODUCT 0
+#endif
+
+#define NUM_KERNELS                             \
+    (4 +                                        \
+     NUM_KERNELS_GATHER +                       \
+     NUM_KERNELS_SCATTER +                      \
+     NUM_KERNELS_INDIRECT_DOT_PRODUCT)
+
+// Each rank contributes one average error per validated array (a, b,
+// c, plus d and e when enabled) and one relative error for the
+// indirect dot product.
+#define NUM_ERR_VALS                            \
+    (3 +                                        \
+     NUM_KERNELS_GATHER +                       \
+     NUM_KERNELS_SCATTER +                      \
+     NUM_KERNELS_INDIRECT_DOT_PRODUCT)
+
 //static STREAM_TYPE	a[STREAM_ARRAY_SIZE+OFFSET],
 //			b[STREAM_ARRAY_SIZE+OFFSET],
 //			c[STREAM_ARRAY_SIZE+OFFSET];
@@ -216,22 +267,73 @@
 // Some compilers require an extra keyword to recognize the "restrict" qualifier.
 double * restrict a, * restrict b, * restrict c;
 
+#if defined(ENABLE_GATHER) || defined(ENABLE_SCATTER) || defined(ENABLE_INDIRECT_DOT_PRODUCT)
+// The index array is called "idx" rather than "i" as in stream.c,
+// since "i" is already a loop index in main() here.
+double * restrict d;
+INDEX_TYPE * restrict idx;
+#endif
+#if defined(ENABLE_SCATTER)
+double * restrict e;
+#endif
+#if defined(ENABLE_INDIRECT_DOT_PRODUCT)
+static STREAM_TYPE x;
+#endif
+
 size_t		array_elements, array_bytes, array_alignment;
-static double	avgtime[4] = {0}, maxtime[4] = {0},
-		mintime[4] = {FLT_MAX,FLT_MAX,FLT_MAX,FLT_MAX};
+#if defined(ENABLE_GATHER) || defined(ENABLE_SCATTER) || defined(ENABLE_INDIRECT_DOT_PRODUCT)
+size_t		index_array_elements;
+#endif
+static double	avgtime[NUM_KERNELS] = {0}, maxtime[NUM_KERNELS] = {0},
+		mintime[NUM_KERNELS] = {FLT_MAX,FLT_MAX,FLT_MAX,FLT_MAX,
+#ifdef ENABLE_GATHER
+		FLT_MAX,
+#endif
+#ifdef ENABLE_SCATTER
+		FLT_MAX,
+#endif
+#ifdef ENABLE_INDIRECT_DOT_PRODUCT
+		FLT_MAX,
+#endif
+		};
 
-static char	*label[4] = {"Copy:      ", "Scale:     ",
-    "Add:       ", "Triad:     "};
+static char	*label[NUM_KERNELS] = {"Copy:      ", "Scale:     ",
+    "Add:       ", "Triad:     ",
+#ifdef ENABLE_GATHER
+    "Gather:    ",
+#endif
+#ifdef ENABLE_SCATTER
+    "Scatter:   ",
+#endif
+#ifdef ENABLE_INDIRECT_DOT_PRODUCT
+    "Ind.dot:   ",
+#endif
+    };
 
-static double	bytes[4] = {
+static double	bytes[NUM_KERNELS] = {
     2 * sizeof(STREAM_TYPE) * STREAM_ARRAY_SIZE,
     2 * sizeof(STREAM_TYPE) * STREAM_ARRAY_SIZE,
     3 * sizeof(STREAM_TYPE) * STREAM_ARRAY_SIZE,
-    3 * sizeof(STREAM_TYPE) * STREAM_ARRAY_SIZE
+    3 * sizeof(STREAM_TYPE) * STREAM_ARRAY_SIZE,
+#ifdef ENABLE_GATHER
+    sizeof(STREAM_TYPE) * MIN(STREAM_ARRAY_SIZE, STREAM_INDEX_ARRAY_SIZE) +
+    sizeof(STREAM_TYPE) * STREAM_INDEX_ARRAY_SIZE +
+    sizeof(INDEX_TYPE) * STREAM_INDEX_ARRAY_SIZE,
+#endif
+#ifdef ENABLE_SCATTER
+    sizeof(STREAM_TYPE) * MIN(STREAM_ARRAY_SIZE, STREAM_INDEX_ARRAY_SIZE) +
+    sizeof(STREAM_TYPE) * STREAM_INDEX_ARRAY_SIZE +
+    sizeof(INDEX_TYPE) * STREAM_INDEX_ARRAY_SIZE,
+#endif
+#ifdef ENABLE_INDIRECT_DOT_PRODUCT
+    sizeof(STREAM_TYPE) * MIN(STREAM_ARRAY_SIZE, STREAM_INDEX_ARRAY_SIZE) +
+    sizeof(STREAM_TYPE) * STREAM_INDEX_ARRAY_SIZE +
+    sizeof(INDEX_TYPE) * STREAM_INDEX_ARRAY_SIZE,
+#endif
     };
 
 extern void checkSTREAMresults(STREAM_TYPE *AvgErrByRank, int numranks);
-extern void computeSTREAMerrors(STREAM_TYPE *aAvgErr, STREAM_TYPE *bAvgErr, STREAM_TYPE *cAvgErr);
+extern void computeSTREAMerrors(STREAM_TYPE *AvgErr);
 #ifdef TUNED
 extern void tuned_STREAM_Copy();
 extern void tuned_STREAM_Scale(STREAM_TYPE scalar);
@@ -247,13 +349,25 @@ main()
     int			quantum, checktick();
     int			BytesPerWord;
     int			i,k;
+#if NUM_KERNELS > 4
+    int			l;
+#endif
+#if defined(ENABLE_GATHER) || defined(ENABLE_SCATTER) || defined(ENABLE_INDIRECT_DOT_PRODUCT)
+    unsigned int	seed;
+#endif
     ssize_t		j;
     STREAM_TYPE		scalar;
-    double		t, times[4][NTIMES];
+    double		t, times[NUM_KERNELS][NTIMES];
 	double		*TimesByRank;
-	double		t0,t1,tmin;
+	double		t0,t1,tmin,tmax;
 	int         rc, numranks, myrank;
-	STREAM_TYPE	AvgError[3] = {0.0,0.0,0.0};
+	MPI_Comm	nodecomm;
+	int		node_rank, node_leader, numnodes;
+	int		*NodeLeaders, *NodeOfRank, *RanksPerNode;
+	double		*NodeTime, *NodeMinTime;
+	double		rmin, rmax, rate;
+	int		imin, imax;
+	STREAM_TYPE	AvgError[NUM_ERR_VALS] = {0.0};
 	STREAM_TYPE *AvgErrByRank;
 
     /* --- SETUP --- call MPI_Init() before anything else! --- */
@@ -268,6 +382,50 @@ main()
 	MPI_Comm_size(MPI_COMM_WORLD, &numranks);
 	MPI_Comm_rank(MPI_COMM_WORLD, &myrank);
 
+	// Identify the ranks sharing each physical node, so results can be
+	// aggregated per node as well as across the whole cluster.  Each
+	// rank learns the world rank of its node's lowest-numbered rank
+	// (the "node leader"), which serves as a node identifier.
+	MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, myrank, MPI_INFO_NULL, &nodecomm);
+	MPI_Comm_rank(nodecomm, &node_rank);
+	node_leader = myrank;
+	MPI_Bcast(&node_leader, 1, MPI_INT, 0, nodecomm);
+
+	// Rank 0 maps each rank's node leader to a dense node number, in
+	// order of first appearance, and counts the ranks on each node.
+	NodeLeaders = NULL;
+	NodeOfRank = NULL;
+	RanksPerNode = NULL;
+	NodeTime = NULL;
+	NodeMinTime = NULL;
+	if (myrank == 0) {
+		NodeLeaders = (int *) malloc(numranks * sizeof(int));
+		NodeOfRank = (int *) malloc(numranks * sizeof(int));
+		RanksPerNode = (int *) malloc(numranks * sizeof(int));
+		if (NodeLeaders == NULL || NodeOfRank == NULL || RanksPerNode == NULL) {
+			printf("Ooops -- allocation of node mapping arrays on MPI rank %d failed\n", myrank);
+			MPI_Abort(MPI_COMM_WORLD, 2);
+			exit(1);
+		}
+	}
+	MPI_Gather(&node_leader, 1, MPI_INT, NodeLeaders, 1, MPI_INT, 0, MPI_COMM_WORLD);
+	numnodes = 0;
+	if (myrank == 0) {
+		for (i=0; i<numranks; i++) {
+			for (k=0; k<i; k++)
+				if (NodeLeaders[k] == NodeLeaders[i])
+					break;
+			if (k < i) {
+				NodeOfRank[i] = NodeOfRank[k];
+			} else {
+				NodeOfRank[i] = numnodes;
+				RanksPerNode[numnodes] = 0;
+				numnodes++;
+			}
+			RanksPerNode[NodeOfRank[i]]++;
+		}
+	}
+
     /* --- NEW FEATURE --- distribute requested storage across MPI ranks --- */
 	array_elements = STREAM_ARRAY_SIZE / numranks;		// don't worry about rounding vs truncation
     array_alignment = 64;						// Can be modified -- provides partial support for adjusting relative alignment
@@ -294,6 +452,31 @@ main()
         exit(1);
     }
 
+#if defined(ENABLE_GATHER) || defined(ENABLE_SCATTER) || defined(ENABLE_INDIRECT_DOT_PRODUCT)
+	// The index arrays are distributed in the same manner as a/b/c.
+	index_array_elements = STREAM_INDEX_ARRAY_SIZE / numranks;
+    k = posix_memalign((void **)&d, array_alignment, index_array_elements * sizeof(STREAM_TYPE));
+    if (k != 0) {
+        printf("Rank %d: Allocation of array d failed, return code is %d\n",myrank,k);
+		MPI_Abort(MPI_COMM_WORLD, 2);
+        exit(1);
+    }
+    k = posix_memalign((void **)&idx, array_alignment, index_array_elements * sizeof(INDEX_TYPE));
+    if (k != 0) {
+        printf("Rank %d: Allocation of array idx failed, return code is %d\n",myrank,k);
+		MPI_Abort(MPI_COMM_WORLD, 2);
+        exit(1);
+    }
+#endif
+#ifdef ENABLE_SCATTER
+    k = posix_memalign((void **)&e, array_alignment, array_bytes);
+    if (k != 0) {
+        printf("Rank %d: Allocation of array e failed, return code is %d\n",myrank,k);
+		MPI_Abort(MPI_COMM_WORLD, 2);
+        exit(1);
+    }
+#endif
+
 	// Initial informational printouts -- rank 0 handles all the output
 	if (myrank == 0) {
 		printf(HLINE);
@@ -325,6 +508,7 @@ main()
 			(3.0 * BytesPerWord) * ( (double) STREAM_ARRAY_SIZE / 1024.0/1024.),
 			(3.0 * BytesPerWord) * ( (double) STREAM_ARRAY_SIZE / 1024.0/1024./1024.));
 		printf("Data is distributed across %d MPI ranks\n",numranks);
+		printf("   MPI ranks span %d node(s)\n",numnodes);
 		printf("   Array size per MPI rank = %llu (elements)\n" , (unsigned long long) array_elements);
 		printf("   Memory per array per MPI rank = %.1f MiB (= %.1f GiB).\n", 
 			BytesPerWord * ( (double) array_elements / 1024.0/1024.0),
@@ -333,6 +517,19 @@ main()
 			(3.0 * BytesPerWord) * ( (double) array_elements / 1024.0/1024.),
 			(3.0 * BytesPerWord) * ( (double) array_elements / 1024.0/1024./1024.));
 
+#if defined(ENABLE_GATHER) || defined(ENABLE_SCATTER) || defined(ENABLE_INDIRECT_DOT_PRODUCT)
+		printf("Total Aggregate Index array size = %llu (elements)\n",
+			(unsigned long long) STREAM_INDEX_ARRAY_SIZE);
+		printf("   Index array size per MPI rank = %llu (elements)\n",
+			(unsigned long long) index_array_elements);
+		printf("   Memory per indexed array per MPI rank = %.1f MiB (= %.1f GiB).\n",
+			BytesPerWord * ( (double) index_array_elements / 1024.0/1024.0),
+			BytesPerWord * ( (double) index_array_elements / 1024.0/1024.0/1024.0));
+		printf("   Memory per index array per MPI rank = %.1f MiB (= %.1f GiB).\n",
+			sizeof(INDEX_TYPE) * ( (double) index_array_elements / 1024.0/1024.0),
+			sizeof(INDEX_TYPE) * ( (double) index_array_elements / 1024.0/1024.0/1024.0));
+#endif
+
 		printf(HLINE);
 		printf("Each kernel will be executed %d times.\n", NTIMES);
 		printf(" The *best* time for each kernel (excluding the first iteration)\n"); 
@@ -370,6 +567,47 @@ main()
 	    c[j] = 0.0;
 	}
 
+#if defined(ENABLE_GATHER) || defined(ENABLE_SCATTER) || defined(ENABLE_INDIRECT_DOT_PRODUCT)
+#pragma omp parallel for
+	for (j=0; j<index_array_elements; j++) {
+		d[j] = 1.0;
+	}
+	// Each rank generates indices into its own portion of the arrays,
+	// so the indexed kernels measure rank-local irregular bandwidth
+	// and no inter-rank communication is needed.
+#pragma omp parallel for
+	for (j=0; j<index_array_elements; j++) {
+		idx[j] = j % array_elements;
+	}
+
+#ifdef PERMUTE_INDEX_ARRAY
+	// Use the Fisher-Yates Shuffle algorithm to generate an unbiased
+	// random permutation for the irregular indices.  Each rank seeds
+	// with its own rank number so the ranks do not all walk the same
+	// permutation.
+#ifdef SRAND_SEED
+	seed = SRAND_SEED + myrank;
+#else
+	seed = time(0) + myrank;
+#endif
+	srand(seed);
+	if (myrank == 0)
+		printf("The index arrays are randomly permuted (rank 0 seed = %d)\n", seed);
+	for (j=0; j<(ssize_t)index_array_elements-2; j++) {
+		ssize_t m = j + rand() % (index_array_elements - j);
+		INDEX_TYPE tmp = idx[j];
+		idx[j] = idx[m];
+		idx[m] = tmp;
+	}
+#endif
+#endif
+#ifdef ENABLE_SCATTER
+#pragma omp parallel for
+	for (j=0; j<array_elements; j++) {
+		e[j] = 0.0;
+	}
+#endif
+
 	// Rank 0 needs to allocate arrays to hold error data and timing data from
 	// all ranks for analysis and output.
 	// Allocate and instantiate the arrays here -- after the primary arrays 
@@ -377,21 +615,21 @@ main()
 	// auxiliary arrays mess up the NUMA placement of the primary arrays.
 
 	if (myrank == 0) {
-		// There are 3 average error values for each rank (using STREAM_TYPE).
-		AvgErrByRank = (double *) malloc(3 * sizeof(STREAM_TYPE) * numranks);
+		// There are NUM_ERR_VALS average error values for each rank (using STREAM_TYPE).
+		AvgErrByRank = (double *) malloc(NUM_ERR_VALS * sizeof(STREAM_TYPE) * numranks);
 		if (AvgErrByRank == NULL) {
 			printf("Ooops -- allocation of arrays to collect errors on MPI rank 0 failed\n");
 			MPI_Abort(MPI_COMM_WORLD, 2);
 		}
-		memset(AvgErrByRank,0,3*sizeof(STREAM_TYPE)*numranks);
+		memset(AvgErrByRank,0,NUM_ERR_VALS*sizeof(STREAM_TYPE)*numranks);
 
-		// There are 4*NTIMES timing values for each rank (always doubles)
-		TimesByRank = (double *) malloc(4 * NTIMES * sizeof(double) * numranks);
+		// There are NUM_KERNELS*NTIMES timing values for each rank (always doubles)
+		TimesByRank = (double *) malloc(NUM_KERNELS * NTIMES * sizeof(double) * numranks);
 		if (TimesByRank == NULL) {
 			printf("Ooops -- allocation of arrays to collect timing data on MPI rank 0 failed\n");
 			MPI_Abort(MPI_COMM_WORLD, 3);
 		}
-		memset(TimesByRank,0,4*NTIMES*sizeof(double)*numranks);
+		memset(TimesByRank,0,NUM_KERNELS*NTIMES*sizeof(double)*numranks);
 	}
 
 	// Simple check for granularity of the timer being used
@@ -448,9 +686,14 @@ main()
     scalar = SCALAR;
     for (k=0; k<NTIMES; k++)
 	{
+		// Keep the nodes in approximate lockstep, then time each kernel
+		// with node-local barriers so each node's timing reflects only
+		// its own memory system, not a slow host elsewhere in the job.
+		MPI_Barrier(MPI_COMM_WORLD);
+
 		// kernel 1: Copy
 		t0 = MPI_Wtime();
-		MPI_Barrier(MPI_COMM_WORLD);
+		MPI_Barrier(nodecomm);
 #ifdef TUNED
         tuned_STREAM_Copy();
 #else
@@ -458,13 +701,13 @@ main()
 		for (j=0; j<array_elements; j++)
 			c[j] = a[j];
 #endif
-		MPI_Barrier(MPI_COMM_WORLD);
+		MPI_Barrier(nodecomm);
 		t1 = MPI_Wtime();
 		times[0][k] = t1 - t0;
 
 		// kernel 2: Scale
 		t0 = MPI_Wtime();
-		MPI_Barrier(MPI_COMM_WORLD);
+		MPI_Barrier(nodecomm);
 #ifdef TUNED
         tuned_STREAM_Scale(scalar);
 #else
@@ -472,13 +715,13 @@ main()
 		for (j=0; j<array_elements; j++)
 			b[j] = scalar*c[j];
 #endif
-		MPI_Barrier(MPI_COMM_WORLD);
+		MPI_Barrier(nodecomm);
 		t1 = MPI_Wtime();
 		times[1][k] = t1-t0;
 	
 		// kernel 3: Add
 		t0 = MPI_Wtime();
-		MPI_Barrier(MPI_COMM_WORLD);
+		MPI_Barrier(nodecomm);
 #ifdef TUNED
         tuned_STREAM_Add();
 #else
@@ -486,13 +729,13 @@ main()
 		for (j=0; j<array_elements; j++)
 			c[j] = a[j]+b[j];
 #endif
-		MPI_Barrier(MPI_COMM_WORLD);
+		MPI_Barrier(nodecomm);
 		t1 = MPI_Wtime();
 		times[2][k] = t1-t0;
 	
 		// kernel 4: Triad
 		t0 = MPI_Wtime();
-		MPI_Barrier(MPI_COMM_WORLD);
+		MPI_Barrier(nodecomm);
 #ifdef TUNED
         tuned_STREAM_Triad(scalar);
 #else
@@ -500,43 +743,101 @@ main()
 		for (j=0; j<array_elements; j++)
 			a[j] = b[j]+scalar*c[j];
 #endif
-		MPI_Barrier(MPI_COMM_WORLD);
+		MPI_Barrier(nodecomm);
 		t1 = MPI_Wtime();
 		times[3][k] = t1-t0;
+
+#if NUM_KERNELS > 4
+		l = 4;
+#endif
+#ifdef ENABLE_GATHER
+		// kernel 5: Gather -- each rank gathers from its own portion of a[]
+		t0 = MPI_Wtime();
+		MPI_Barrier(nodecomm);
+#pragma omp parallel for
+		for (j=0; j<index_array_elements; j++)
+			d[j] = a[idx[j]];
+		MPI_Barrier(nodecomm);
+		t1 = MPI_Wtime();
+		times[l][k] = t1-t0;
+		l++;
+#endif
+#ifdef ENABLE_SCATTER
+		// kernel: Scatter
+		t0 = MPI_Wtime();
+		MPI_Barrier(nodecomm);
+#pragma omp parallel for
+		for (j=0; j<index_array_elements; j++)
+			e[idx[j]] = d[j];
+		MPI_Barrier(nodecomm);
+		t1 = MPI_Wtime();
+		times[l][k] = t1-t0;
+		l++;
+#endif
+#ifdef ENABLE_INDIRECT_DOT_PRODUCT
+		// kernel: Indirect dot product
+		x = 0.0;
+		t0 = MPI_Wtime();
+		MPI_Barrier(nodecomm);
+#pragma omp parallel for reduction(+:x)
+		for (j=0; j<index_array_elements; j++)
+			x += d[j] * b[idx[j]];
+		MPI_Barrier(nodecomm);
+		t1 = MPI_Wtime();
+		times[l][k] = t1-t0;
+		l++;
+#endif
 	}
 
 	t0 = MPI_Wtime();
 
     /*	--- SUMMARY --- */
 
-	// Because of the MPI_Barrier() calls, the timings from any thread are equally valid. 
-    // The best estimate of the maximum performance is the minimum of the "outside the barrier"
-    // timings across all the MPI ranks.
+	// Because of the node-local MPI_Barrier() calls, the timings from any rank *on the
+	// same node* are equally valid, so the per-node time for an iteration is the minimum
+	// of the "outside the barrier" timings across that node's ranks.  The cluster finishes
+	// an iteration only when its slowest node does, so the cluster-wide time is the
+	// maximum of the per-node times.
 
 	// Gather all timing data to MPI rank 0
-	MPI_Gather(times, 4*NTIMES, MPI_DOUBLE, TimesByRank, 4*NTIMES, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+	MPI_Gather(times, NUM_KERNELS*NTIMES, MPI_DOUBLE, TimesByRank, NUM_KERNELS*NTIMES, MPI_DOUBLE, 0, MPI_COMM_WORLD);
 
 	// Rank 0 processes all timing data
 	if (myrank == 0) {
-		// for each iteration and each kernel, collect the minimum time across all MPI ranks
-		// and overwrite the rank 0 "times" variable with the minimum so the original post-
-		// processing code can still be used.
+		// for each iteration and each kernel, reduce the per-rank times to per-node
+		// times and overwrite the rank 0 "times" variable with the cluster-wide
+		// (slowest node) time so the original post-processing code can still be used.
+		NodeTime = (double *) malloc(numnodes * sizeof(double));
+		NodeMinTime = (double *) malloc(numnodes * NUM_KERNELS * sizeof(double));
+		if (NodeTime == NULL || NodeMinTime == NULL) {
+			printf("Ooops -- allocation of per-node timing arrays on MPI rank %d failed\n", myrank);
+			MPI_Abort(MPI_COMM_WORLD, 2);
+			exit(1);
+		}
+		for (i=0; i<numnodes*NUM_KERNELS; i++)
+			NodeMinTime[i] = 1.0e36;
 		for (k=0; k<NTIMES; k++) {
-			for (j=0; j<4; j++) {
-				tmin = 1.0e36;
+			for (j=0; j<NUM_KERNELS; j++) {
+				for (i=0; i<numnodes; i++)
+					NodeTime[i] = 1.0e36;
 				for (i=0; i<numranks; i++) {
-					// printf("DEBUG: Timing: iter %d, kernel %lu, rank %d, tmin %f, TbyRank %f\n",k,j,i,tmin,TimesByRank[4*NTIMES*i+j*NTIMES+k]);
-					tmin = MIN(tmin, TimesByRank[4*NTIMES*i+j*NTIMES+k]);
+					tmin = MIN(NodeTime[NodeOfRank[i]], TimesByRank[NUM_KERNELS*NTIMES*i+j*NTIMES+k]);
+					NodeTime[NodeOfRank[i]] = tmin;
+				}
+				tmax = 0.0;
+				for (i=0; i<numnodes; i++) {
+					tmax = MAX(tmax, NodeTime[i]);
+					if (k > 0)	// skip first iteration, as in the summary below
+						NodeMinTime[NUM_KERNELS*i+j] = MIN(NodeMinTime[NUM_KERNELS*i+j], NodeTime[i]);
 				}
-				// printf("DEBUG: Final Timing: iter %d, kernel %lu, final tmin %f\n",k,j,tmin);
-				times[j][k] = tmin;
+				times[j][k] = tmax;
 			}
 		}
 
 	// Back to the original code, but now using the minimum global timing across all ranks
 		for (k=1; k<NTIMES; k++) /* note -- skip first iteration */
 		{
-		for (j=0; j<4; j++)
+		for (j=0; j<NUM_KERNELS; j++)
 			{
 			avgtime[j] = avgtime[j] + times[j][k];
 			mintime[j] = MIN(mintime[j], times[j][k]);
@@ -546,7 +847,7 @@ main()
     
 		// note that "bytes[j]" is the aggregate array size, so no "numranks" is needed here
 		printf("Function    Best Rate MB/s  Avg time     Min time     Max time\n");
-		for (j=0; j<4; j++) {
+		for (j=0; j<NUM_KERNELS; j++) {
 			avgtime[j] = avgtime[j]/(double)(NTIMES-1);
 
 			printf("%s%11.1f  %11.6f  %11.6f  %11.6f\n", label[j],
@@ -556,22 +857,50 @@ main()
 			   maxtime[j]);
 		}
 		printf(HLINE);
+
+		// Per-node summary: the per-node best rates expose a slow host that
+		// the cluster-wide numbers above would otherwise hide.  Each node's
+		// rate uses its share of the aggregate traffic, so with unequal
+		// numbers of ranks per node the rates remain comparable.
+		printf("Bandwidth per node (computed from node-local timings):\n");
+		printf("Function    Min Rate MB/s (node)   Max Rate MB/s (node)    Max/Min\n");
+		for (j=0; j<NUM_KERNELS; j++) {
+			rmin = 1.0e36;
+			rmax = 0.0;
+			imin = 0;
+			imax = 0;
+			for (i=0; i<numnodes; i++) {
+				rate = 1.0E-06 * (bytes[j] * (double) RanksPerNode[i] / (double) numranks)
+					/ NodeMinTime[NUM_KERNELS*i+j];
+				if (rate < rmin) {
+					rmin = rate;
+					imin = i;
+				}
+				if (rate > rmax) {
+					rmax = rate;
+					imax = i;
+				}
+			}
+			printf("%s%14.1f (%4d)  %14.1f (%4d)  %9.3f\n", label[j],
+			   rmin, imin, rmax, imax, rmax/rmin);
+		}
+		printf(HLINE);
 	}
 
     /* --- Every Rank Checks its Results --- */
 #ifdef INJECTERROR
 	a[11] = 100.0 * a[11];
 #endif
-	computeSTREAMerrors(&AvgError[0], &AvgError[1], &AvgError[2]);
+	computeSTREAMerrors(AvgError);
 	/* --- Collect the Average Errors for Each Array on Rank 0 --- */
-	MPI_Gather(AvgError, 3, MPI_DOUBLE, AvgErrByRank, 3, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+	MPI_Gather(AvgError, NUM_ERR_VALS, MPI_DOUBLE, AvgErrByRank, NUM_ERR_VALS, MPI_DOUBLE, 0, MPI_COMM_WORLD);
 
 	/* -- Combined averaged errors and report on Rank 0 only --- */
 	if (myrank == 0) {
 #ifdef VERBOSE
 		for (k=0; k<numranks; k++) {
-			printf("VERBOSE: rank %d, AvgErrors %e %e %e\n",k,AvgErrByRank[3*k+0],
-				AvgErrByRank[3*k+1],AvgErrByRank[3*k+2]);
+			printf("VERBOSE: rank %d, AvgErrors %e %e %e\n",k,AvgErrByRank[NUM_ERR_VALS*k+0],
+				AvgErrByRank[NUM_ERR_VALS*k+1],AvgErrByRank[NUM_ERR_VALS*k+2]);
 		}
 #endif
 		checkSTREAMresults(AvgErrByRank,numranks);
@@ -588,11 +917,24 @@ main()
 	free(a);
 	free(b);
 	free(c);
+#if defined(ENABLE_GATHER) || defined(ENABLE_SCATTER) || defined(ENABLE_INDIRECT_DOT_PRODUCT)
+	free(d);
+	free(idx);
+#endif
+#ifdef ENABLE_SCATTER
+	free(e);
+#endif
 	if (myrank == 0) {
 		free(TimesByRank);
 		free(AvgErrByRank);
+		free(NodeLeaders);
+		free(NodeOfRank);
+		free(RanksPerNode);
+		free(NodeTime);
+		free(NodeMinTime);
 	}
 
+	MPI_Comm_free(&nodecomm);
     MPI_Finalize();
 	return(0);
 }
@@ -637,10 +979,25 @@ checktick()
 #ifndef abs
 #define abs(a) ((a) >= 0 ? (a) : -(a))
 #endif
-void computeSTREAMerrors(STREAM_TYPE *aAvgErr, STREAM_TYPE *bAvgErr, STREAM_TYPE *cAvgErr)
+// AvgErr[] holds NUM_ERR_VALS entries: the average absolute errors for
+// a/b/c, then (when enabled) the average absolute errors for d and e,
+// and the relative error of the indirect dot product.
+void computeSTREAMerrors(STREAM_TYPE *AvgErr)
 {
 	STREAM_TYPE aj,bj,cj,scalar;
 	STREAM_TYPE aSumErr,bSumErr,cSumErr;
+#ifdef ENABLE_GATHER
+	STREAM_TYPE dj,dSumErr;
+#endif
+#ifdef ENABLE_SCATTER
+	STREAM_TYPE ej,eSumErr;
+#endif
+#ifdef ENABLE_INDIRECT_DOT_PRODUCT
+	STREAM_TYPE xj;
+#endif
+#if NUM_ERR_VALS > 3
+	int	n;
+#endif
 	ssize_t	j;
 	int	k;
 
@@ -658,6 +1015,16 @@ void computeSTREAMerrors(STREAM_TYPE *aAvgErr, STREAM_TYPE *bAvgErr, STREAM_TYPE
             bj = scalar*cj;
             cj = aj+bj;
             aj = bj+scalar*cj;
+#ifdef ENABLE_GATHER
+            dj = aj;
+#endif
+#ifdef ENABLE_SCATTER
+#ifdef ENABLE_GATHER
+            ej = aj;
+#else
+            ej = 0.0;
+#endif
+#endif
         }
 
     /* accumulate deltas between observed and expected results */
@@ -669,9 +1036,37 @@ void computeSTREAMerrors(STREAM_TYPE *aAvgErr, STREAM_TYPE *bAvgErr, STREAM_TYPE
 		bSumErr += abs(b[j] - bj);
 		cSumErr += abs(c[j] - cj);
 	}
-	*aAvgErr = aSumErr / (STREAM_TYPE) array_elements;
-	*bAvgErr = bSumErr / (STREAM_TYPE) array_elements;
-	*cAvgErr = cSumErr / (STREAM_TYPE) array_elements;
+	AvgErr[0] = aSumErr / (STREAM_TYPE) array_elements;
+	AvgErr[1] = bSumErr / (STREAM_TYPE) array_elements;
+	AvgErr[2] = cSumErr / (STREAM_TYPE) array_elements;
+
+#if NUM_ERR_VALS > 3
+	n = 3;
+#endif
+#ifdef ENABLE_GATHER
+	dSumErr = 0.0;
+	for (j=0; j<index_array_elements; j++) {
+		dSumErr += abs(d[j] - dj);
+	}
+	AvgErr[n++] = dSumErr / (STREAM_TYPE) index_array_elements;
+#endif
+#ifdef ENABLE_SCATTER
+	// only the elements actually addressed by the index array carry
+	// the scattered value, so scan through the index array
+	eSumErr = 0.0;
+	for (j=0; j<index_array_elements; j++) {
+		eSumErr += abs(e[idx[j]] - ej);
+	}
+	AvgErr[n++] = eSumErr / (STREAM_TYPE) array_elements;
+#endif
+#ifdef ENABLE_INDIRECT_DOT_PRODUCT
+	// recompute the reduction serially from the final arrays and
+	// report the relative error of the parallel result
+	xj = 0.0;
+	for (j=0; j<index_array_elements; j++)
+		xj += d[j] * b[idx[j]];
+	AvgErr[n++] = abs((x - xj)/xj);
+#endif
 }
 
 
@@ -681,6 +1076,18 @@ void checkSTREAMresults (STREAM_TYPE *AvgErrByRank, int numranks)
 	STREAM_TYPE aj,bj,cj,scalar;
 	STREAM_TYPE aSumErr,bSumErr,cSumErr;
 	STREAM_TYPE aAvgErr,bAvgErr,cAvgErr;
+#ifdef ENABLE_GATHER
+	STREAM_TYPE dj,dSumErr,dAvgErr;
+#endif
+#ifdef ENABLE_SCATTER
+	STREAM_TYPE ej,eSumErr,eAvgErr;
+#endif
+#ifdef ENABLE_INDIRECT_DOT_PRODUCT
+	STREAM_TYPE xSumErr,xAvgErr;
+#endif
+#if NUM_ERR_VALS > 3
+	int	n;
+#endif
 	double epsilon;
 	ssize_t	j;
 	int	k,ierr,err;
@@ -700,20 +1107,60 @@ void checkSTREAMresults (STREAM_TYPE *AvgErrByRank, int numranks)
             bj = scalar*cj;
             cj = aj+bj;
             aj = bj+scalar*cj;
+#ifdef ENABLE_GATHER
+            dj = aj;
+#endif
+#ifdef ENABLE_SCATTER
+#ifdef ENABLE_GATHER
+            ej = aj;
+#else
+            ej = 0.0;
+#endif
+#endif
         }
 
 	// Compute the average of the average errors contributed by each MPI rank
 	aSumErr = 0.0;
 	bSumErr = 0.0;
 	cSumErr = 0.0;
+#ifdef ENABLE_GATHER
+	dSumErr = 0.0;
+#endif
+#ifdef ENABLE_SCATTER
+	eSumErr = 0.0;
+#endif
+#ifdef ENABLE_INDIRECT_DOT_PRODUCT
+	xSumErr = 0.0;
+#endif
 	for (k=0; k<numranks; k++) {
-		aSumErr += AvgErrByRank[3*k + 0];
-		bSumErr += AvgErrByRank[3*k + 1];
-		cSumErr += AvgErrByRank[3*k + 2];
+		aSumErr += AvgErrByRank[NUM_ERR_VALS*k + 0];
+		bSumErr += AvgErrByRank[NUM_ERR_VALS*k + 1];
+		cSumErr += AvgErrByRank[NUM_ERR_VALS*k + 2];
+#if NUM_ERR_VALS > 3
+		n = 3;
+#endif
+#ifdef ENABLE_GATHER
+		dSumErr += AvgErrByRank[NUM_ERR_VALS*k + n]; n++;
+#endif
+#ifdef ENABLE_SCATTER
+		eSumErr += AvgErrByRank[NUM_ERR_VALS*k + n]; n++;
+#endif
+#ifdef ENABLE_INDIRECT_DOT_PRODUCT
+		xSumErr += AvgErrByRank[NUM_ERR_VALS*k + n]; n++;
+#endif
 	}
 	aAvgErr = aSumErr / (STREAM_TYPE) numranks;
 	bAvgErr = bSumErr / (STREAM_TYPE) numranks;
 	cAvgErr = cSumErr / (STREAM_TYPE) numranks;
+#ifdef ENABLE_GATHER
+	dAvgErr = dSumErr / (STREAM_TYPE) numranks;
+#endif
+#ifdef ENABLE_SCATTER
+	eAvgErr = eSumErr / (STREAM_TYPE) numranks;
+#endif
+#ifdef ENABLE_INDIRECT_DOT_PRODUCT
+	xAvgErr = xSumErr / (STREAM_TYPE) numranks;
+#endif
 
 	if (sizeof(STREAM_TYPE) == 4) {
 		epsilon = 1.e-6;
@@ -783,6 +1230,58 @@ void checkSTREAMresults (STREAM_TYPE *AvgErrByRank, int numranks)
 		}
 		printf("     For array c[], %d errors were found.\n",ierr);
 	}
+#ifdef ENABLE_GATHER
+	if (abs(dAvgErr/dj) > epsilon) {
+		err++;
+		printf ("Failed Validation on array d[], AvgRelAbsErr > epsilon (%e)\n",epsilon);
+		printf ("     Expected Value: %e, AvgAbsErr: %e, AvgRelAbsErr: %e\n",dj,dAvgErr,abs(dAvgErr)/dj);
+		printf ("     AvgRelAbsErr > Epsilon (%e)\n",epsilon);
+		ierr = 0;
+		for (j=0; j<index_array_elements; j++) {
+			if (abs(d[j]/dj-1.0) > epsilon) {
+				ierr++;
+#ifdef VERBOSE
+				if (ierr < 10) {
+					printf("         array d: index: %ld, expected: %e, observed: %e, relative error: %e\n",
+						j,dj,d[j],abs((dj-d[j])/dAvgErr));
+				}
+#endif
+			}
+		}
+		printf("     For array d[], %d errors were found.\n",ierr);
+	}
+#endif
+#ifdef ENABLE_SCATTER
+	if (abs(eAvgErr/ej) > epsilon) {
+		err++;
+		printf ("Failed Validation on array e[], AvgRelAbsErr > epsilon (%e)\n",epsilon);
+		printf ("     Expected Value: %e, AvgAbsErr: %e, AvgRelAbsErr: %e\n",ej,eAvgErr,abs(eAvgErr)/ej);
+		printf ("     AvgRelAbsErr > Epsilon (%e)\n",epsilon);
+		ierr = 0;
+		for (j=0; j<index_array_elements; j++) {
+			if (abs(e[idx[j]]/ej-1.0) > epsilon) {
+				ierr++;
+#ifdef VERBOSE
+				if (ierr < 10) {
+					printf("         array e: index: %ld, expected: %e, observed: %e, relative error: %e\n",
+						(long) idx[j],ej,e[idx[j]],abs((ej-e[idx[j]])/eAvgErr));
+				}
+#endif
+			}
+		}
+		printf("     For array e[], %d errors were found.\n",ierr);
+	}
+#endif
+#ifdef ENABLE_INDIRECT_DOT_PRODUCT
+	// the per-rank relative errors were averaged across the ranks;
+	// rounding accumulates over index_array_elements additions, so the
+	// tolerance must scale with the length of the reduction
+	if (xAvgErr > epsilon * (double) index_array_elements) {
+		err++;
+		printf ("Failed Validation on value x, AvgRelAbsErr > epsilon*N (%e)\n",epsilon * (double) index_array_elements);
+		printf ("     AvgRelAbsErr: %e\n",xAvgErr);
+	}
+#endif
 	if (err == 0) {
 		printf ("Solution Validates: avg error less than %e on all three arrays\n",epsilon);
 	}
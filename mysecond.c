@@ -1,10 +1,25 @@
-/* A gettimeofday routine to give access to the wall
-   clock timer on most UNIX-like systems.
+/* A wall clock timer for most UNIX-like systems.
 
-   This version defines two entry points -- with 
+   This version defines two entry points -- with
    and without appended underscores, so it *should*
    automagically link with FORTRAN */
 
+/* The default implementation reads the CPU cycle counter (rdtsc on
+   x86, cntvct on AArch64) and converts it to seconds with a scale
+   calibrated once, on the first call, against a short interval of
+   clock_gettime(CLOCK_MONOTONIC_RAW).  This keeps the cost of a
+   reading to a few nanoseconds and the resolution well below a
+   microsecond, which matters when individual kernel times are only
+   tens of microseconds (e.g. cache-resident array sizes).  On
+   machines without a constant-rate cycle counter the code falls back
+   to clock_gettime() directly.
+
+   Define USE_CLOCK_GETTIME to skip the cycle-counter fast path, or
+   USE_GETTIMEOFDAY to get the historical gettimeofday() timer with
+   microsecond granularity. */
+
+#ifdef USE_GETTIMEOFDAY
+
 #include <sys/time.h>
 
 double mysecond()
@@ -23,5 +38,98 @@ struct timezone { int   tz_minuteswest;
         return ( (double) tp.tv_sec + (double) tp.tv_usec * 1.e-6 );
 }
 
-double mysecond_() {return mysecond();}
+#else
+
+#include <time.h>
+
+static double raw_second()
+{
+        struct timespec t;
+        clock_gettime(CLOCK_MONOTONIC_RAW, &t);
+        return ( (double) t.tv_sec + (double) t.tv_nsec * 1.e-9 );
+}
+
+#ifdef USE_CLOCK_GETTIME
+
+double mysecond()
+{
+        return raw_second();
+}
+
+#else
+
+/* Read the CPU cycle counter, and report whether the counter is
+   architecturally guaranteed to tick at a constant rate regardless of
+   frequency scaling, so it is safe to use as a time base. */
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+static unsigned long long read_cycle_counter()
+{
+        unsigned int lo, hi;
+        __asm__ __volatile__("rdtsc" : "=a"(lo), "=d"(hi));
+        return ((unsigned long long) hi << 32) | lo;
+}
+static int have_invariant_counter()
+{
+        unsigned int eax, ebx, ecx, edx;
+        if (__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) == 0)
+                return 0;
+        return (edx >> 8) & 1;  /* invariant TSC */
+}
+#elif defined(__aarch64__)
+static unsigned long long read_cycle_counter()
+{
+        unsigned long long c;
+        __asm__ __volatile__("mrs %0, cntvct_el0" : "=r"(c));
+        return c;
+}
+static int have_invariant_counter()
+{
+        return 1;       /* the generic timer runs at a fixed frequency */
+}
+#else
+static unsigned long long read_cycle_counter()
+{
+        return 0;
+}
+static int have_invariant_counter()
+{
+        return 0;
+}
+#endif
+
+double mysecond()
+{
+        static int use_counter = -1;
+        static double base_time, ticks_per_sec;
+        static unsigned long long base_ticks;
 
+        if (use_counter < 0) {
+                use_counter = have_invariant_counter();
+                if (use_counter) {
+                        /* Calibrate the counter against ~1 ms of
+                           CLOCK_MONOTONIC_RAW.  This runs once, on the
+                           first call, which in STREAM happens during
+                           setup, well before any timed kernel. */
+                        double t0, t1;
+                        unsigned long long c0, c1;
+                        t0 = raw_second();
+                        c0 = read_cycle_counter();
+                        while ( ((t1 = raw_second()) - t0) < 1.0e-3 )
+                                ;
+                        c1 = read_cycle_counter();
+                        ticks_per_sec = (double) (c1 - c0) / (t1 - t0);
+                        base_time = t1;
+                        base_ticks = c1;
+                }
+        }
+        if (use_counter)
+                return base_time +
+                        (double) (read_cycle_counter() - base_ticks) / ticks_per_sec;
+        return raw_second();
+}
+
+#endif
+#endif
+
+double mysecond_() {return mysecond();}
@@ -0,0 +1,397 @@
+/*-----------------------------------------------------------------------*/
+/* Program: STREAM (GPU/accelerator offload edition)                     */
+/* Based on STREAM version 5.10, Copyright 1991-2013: John D. McCalpin   */
+/* This file is licensed under the same terms as stream.c; see the       */
+/* license block at the top of stream.c.                                 */
+/*-----------------------------------------------------------------------*/
+/* This variant runs the four STREAM kernels on an OpenMP target         */
+/* offload device (GPU), with the same label[]/bytes[] reporting and     */
+/* the same checkSTREAMresults() validation model as stream.c, so the    */
+/* device numbers can be compared directly against the host numbers      */
+/* from stream_c.exe.  It also measures host-to-device and device-to-    */
+/* host transfer bandwidth over the interconnect (PCIe/NVLink), which    */
+/* bounds how fast data can be staged for the kernels in the first       */
+/* place.                                                                */
+/*                                                                       */
+/* Build with an OpenMP compiler configured for target offload, e.g.    */
+/*     make stream_gpu OFFLOAD_FLAGS="-fopenmp -foffload=nvptx-none"    */
+/* Without a configured device the kernels fall back to the host and    */
+/* the program says so, so the output cannot be mistaken for a device   */
+/* measurement.                                                          */
+/*-----------------------------------------------------------------------*/
+# include <stdio.h>
+# include <stdlib.h>
+# include <math.h>
+# include <float.h>
+# include <limits.h>
+# include <omp.h>
+
+#ifndef STREAM_ARRAY_SIZE
+#   define STREAM_ARRAY_SIZE	10000000
+#endif
+
+#ifndef NTIMES
+#   define NTIMES	10
+#endif
+
+#ifndef OFFSET
+#   define OFFSET	0
+#endif
+
+#define HLINE "-------------------------------------------------------------\n"
+
+#ifndef MIN
+#define MIN(x,y) ((x)<(y)?(x):(y))
+#endif
+#ifndef MAX
+#define MAX(x,y) ((x)>(y)?(x):(y))
+#endif
+
+#ifndef STREAM_TYPE
+#define STREAM_TYPE double
+#endif
+
+static STREAM_TYPE	*a, *b, *c;
+
+static double	avgtime[4] = {0}, maxtime[4] = {0},
+    mintime[4] = {FLT_MAX,FLT_MAX,FLT_MAX,FLT_MAX};
+
+static char	*label[4] = {"Copy:      ", "Scale:     ",
+    "Add:       ", "Triad:     "};
+
+static double	bytes[4] = {
+    2 * sizeof(STREAM_TYPE) * STREAM_ARRAY_SIZE,
+    2 * sizeof(STREAM_TYPE) * STREAM_ARRAY_SIZE,
+    3 * sizeof(STREAM_TYPE) * STREAM_ARRAY_SIZE,
+    3 * sizeof(STREAM_TYPE) * STREAM_ARRAY_SIZE
+    };
+
+extern double mysecond();
+extern void checkSTREAMresults();
+int checktick();
+
+int
+main()
+    {
+    int			quantum;
+    int			BytesPerWord;
+    int			k;
+    ssize_t		j;
+    ssize_t		n = STREAM_ARRAY_SIZE;
+    STREAM_TYPE		scalar;
+    double		t, times[4][NTIMES];
+    double		h2d, d2h;
+    int			num_devices;
+
+    /* --- SETUP --- determine precision and check timing --- */
+
+    printf(HLINE);
+    printf("STREAM version $Revision: 5.10 $ -- GPU offload edition\n");
+    printf(HLINE);
+    BytesPerWord = sizeof(STREAM_TYPE);
+    printf("This system uses %d bytes per array element.\n",
+	BytesPerWord);
+
+    printf(HLINE);
+    printf("Array size = %llu (elements), Offset = %d (elements)\n",
+	(unsigned long long) STREAM_ARRAY_SIZE, OFFSET);
+    printf("Memory per array = %.1f MiB (= %.1f GiB).\n",
+	BytesPerWord * ( (double) STREAM_ARRAY_SIZE / 1024.0/1024.0),
+	BytesPerWord * ( (double) STREAM_ARRAY_SIZE / 1024.0/1024.0/1024.0));
+    printf("Total memory required = %.1f MiB (= %.1f GiB).\n",
+	(3.0 * BytesPerWord) * ( (double) STREAM_ARRAY_SIZE / 1024.0/1024.),
+	(3.0 * BytesPerWord) * ( (double) STREAM_ARRAY_SIZE / 1024.0/1024./1024.));
+    printf("Each kernel will be executed %d times.\n", NTIMES);
+    printf(" The *best* time for each kernel (excluding the first iteration)\n");
+    printf(" will be used to compute the reported bandwidth.\n");
+
+    printf(HLINE);
+    num_devices = omp_get_num_devices();
+    if (num_devices > 0) {
+	printf("Kernels will run on offload device %d of %d.\n",
+	    omp_get_default_device(), num_devices);
+    } else {
+	printf("*****  WARNING: ******\n");
+	printf("      No offload device found -- the kernels will run\n");
+	printf("      on the HOST.  The results below are NOT device\n");
+	printf("      memory bandwidth.\n");
+	printf("*****  WARNING: ******\n");
+    }
+    printf(HLINE);
+
+    a = (STREAM_TYPE *) malloc((STREAM_ARRAY_SIZE+OFFSET) * sizeof(STREAM_TYPE));
+    b = (STREAM_TYPE *) malloc((STREAM_ARRAY_SIZE+OFFSET) * sizeof(STREAM_TYPE));
+    c = (STREAM_TYPE *) malloc((STREAM_ARRAY_SIZE+OFFSET) * sizeof(STREAM_TYPE));
+    if (a == NULL || b == NULL || c == NULL) {
+	printf("Allocation of the host arrays failed.\n");
+	exit(1);
+    }
+
+    /* Get initial value for system clock. */
+#pragma omp parallel for
+    for (j=0; j<STREAM_ARRAY_SIZE; j++) {
+	    a[j] = 1.0;
+	    b[j] = 2.0;
+	    c[j] = 0.0;
+	}
+
+    if  ( (quantum = checktick()) >= 1)
+	printf("Your clock granularity/precision appears to be "
+	    "%d microseconds.\n", quantum);
+    else {
+	printf("Your clock granularity appears to be "
+	    "less than one microsecond.\n");
+	quantum = 1;
+    }
+
+    /* Allocate the device copies and measure the transfer bandwidth
+     * in both directions while the data is staged.  The best of
+     * NTIMES transfers is reported, in line with the kernel
+     * convention. */
+#pragma omp target enter data map(alloc: a[0:n], b[0:n], c[0:n])
+
+    h2d = FLT_MAX;
+    d2h = FLT_MAX;
+    for (k=0; num_devices > 0 && k<NTIMES; k++) {
+	t = mysecond();
+#pragma omp target update to(a[0:n], b[0:n], c[0:n])
+	t = mysecond() - t;
+	if (k > 0)
+	    h2d = MIN(h2d, t);
+
+	t = mysecond();
+#pragma omp target update from(a[0:n], b[0:n], c[0:n])
+	t = mysecond() - t;
+	if (k > 0)
+	    d2h = MIN(d2h, t);
+    }
+    if (num_devices > 0) {
+	printf(HLINE);
+	printf("Host-device transfer (3 arrays, %.1f MiB per direction):\n",
+	    (3.0 * BytesPerWord) * ( (double) STREAM_ARRAY_SIZE / 1024.0/1024.));
+	printf("Direction       Best Rate MB/s     Time\n");
+	printf("Host-to-device %15.1f  %11.6f\n",
+	    1.0E-06 * 3.0 * BytesPerWord * STREAM_ARRAY_SIZE / h2d, h2d);
+	printf("Device-to-host %15.1f  %11.6f\n",
+	    1.0E-06 * 3.0 * BytesPerWord * STREAM_ARRAY_SIZE / d2h, d2h);
+	printf(HLINE);
+    }
+
+    t = mysecond();
+#pragma omp target teams distribute parallel for
+    for (j = 0; j < n; j++)
+	a[j] = 2.0E0 * a[j];
+    t = 1.0E6 * (mysecond() - t);
+
+    printf("Each test below will take on the order"
+	" of %d microseconds.\n", (int) t  );
+    printf("   (= %d clock ticks)\n", (int) (t/quantum) );
+    printf("Increase the size of the arrays if this shows that\n");
+    printf("you are not getting at least 20 clock ticks per test.\n");
+
+    printf(HLINE);
+
+    printf("WARNING -- The above is only a rough guideline.\n");
+    printf("For best results, please be sure you know the\n");
+    printf("precision of your system timer.\n");
+    printf(HLINE);
+
+    /*	--- MAIN LOOP --- repeat test cases NTIMES times --- */
+
+    scalar = 3.0;
+    for (k=0; k<NTIMES; k++)
+	{
+	times[0][k] = mysecond();
+#pragma omp target teams distribute parallel for
+	for (j=0; j<n; j++)
+	    c[j] = a[j];
+	times[0][k] = mysecond() - times[0][k];
+
+	times[1][k] = mysecond();
+#pragma omp target teams distribute parallel for
+	for (j=0; j<n; j++)
+	    b[j] = scalar*c[j];
+	times[1][k] = mysecond() - times[1][k];
+
+	times[2][k] = mysecond();
+#pragma omp target teams distribute parallel for
+	for (j=0; j<n; j++)
+	    c[j] = a[j]+b[j];
+	times[2][k] = mysecond() - times[2][k];
+
+	times[3][k] = mysecond();
+#pragma omp target teams distribute parallel for
+	for (j=0; j<n; j++)
+	    a[j] = b[j]+scalar*c[j];
+	times[3][k] = mysecond() - times[3][k];
+	}
+
+    /*	--- SUMMARY --- */
+
+    for (k=1; k<NTIMES; k++) /* note -- skip first iteration */
+	{
+	for (j=0; j<4; j++)
+	    {
+	    avgtime[j] = avgtime[j] + times[j][k];
+	    mintime[j] = MIN(mintime[j], times[j][k]);
+	    maxtime[j] = MAX(maxtime[j], times[j][k]);
+	    }
+	}
+
+    printf("Function    Best Rate MB/s  Avg time     Min time     Max time\n");
+    for (j=0; j<4; j++) {
+		avgtime[j] = avgtime[j]/(double)(NTIMES-1);
+
+		printf("%s%12.1f  %11.6f  %11.6f  %11.6f\n", label[j],
+	       1.0E-06 * bytes[j]/mintime[j],
+	       avgtime[j],
+	       mintime[j],
+	       maxtime[j]);
+    }
+    printf(HLINE);
+
+    /* --- Check Results --- the arrays come back from the device and
+     * are validated on the host with the standard replay. */
+#pragma omp target update from(a[0:n], b[0:n], c[0:n])
+#pragma omp target exit data map(delete: a[0:n], b[0:n], c[0:n])
+    checkSTREAMresults();
+    printf(HLINE);
+
+    free(a);
+    free(b);
+    free(c);
+    return 0;
+}
+
+# define	M	20
+
+int
+checktick()
+    {
+    int		i, minDelta, Delta;
+    double	t1, t2, timesfound[M];
+
+/*  Collect a sequence of M unique time values from the system. */
+
+    for (i = 0; i < M; i++) {
+	t1 = mysecond();
+	while( ((t2=mysecond()) - t1) < 1.0E-6 )
+	    ;
+	timesfound[i] = t1 = t2;
+	}
+
+/*
+ * Determine the minimum difference between these M values.
+ * This result will be our estimate (in microseconds) for the
+ * clock granularity.
+ */
+
+    minDelta = 1000000;
+    for (i = 1; i < M; i++) {
+	Delta = (int)( 1.0E6 * (timesfound[i]-timesfound[i-1]));
+	minDelta = MIN(minDelta, MAX(Delta,0));
+	}
+
+   return(minDelta);
+    }
+
+/* The OpenMP runtime is required for offload anyway, so its portable
+ * wall-clock timer serves as the time base. */
+double mysecond()
+{
+	return omp_get_wtime();
+}
+
+#ifndef abs
+#define abs(a) ((a) >= 0 ? (a) : -(a))
+#endif
+void checkSTREAMresults ()
+{
+	STREAM_TYPE aj,bj,cj,scalar;
+	STREAM_TYPE aSumErr,bSumErr,cSumErr;
+	STREAM_TYPE aAvgErr,bAvgErr,cAvgErr;
+	double epsilon;
+	ssize_t	j;
+	int	k,ierr,err;
+
+    /* reproduce initialization */
+	aj = 1.0;
+	bj = 2.0;
+	cj = 0.0;
+    /* a[] is modified during timing check */
+	aj = 2.0E0 * aj;
+    /* now execute timing loop */
+	scalar = 3.0;
+	for (k=0; k<NTIMES; k++)
+        {
+            cj = aj;
+            bj = scalar*cj;
+            cj = aj+bj;
+            aj = bj+scalar*cj;
+        }
+
+    /* accumulate deltas between observed and expected results */
+	aSumErr = 0.0;
+	bSumErr = 0.0;
+	cSumErr = 0.0;
+	for (j=0; j<STREAM_ARRAY_SIZE; j++) {
+		aSumErr += abs(a[j] - aj);
+		bSumErr += abs(b[j] - bj);
+		cSumErr += abs(c[j] - cj);
+	}
+	aAvgErr = aSumErr / (STREAM_TYPE) STREAM_ARRAY_SIZE;
+	bAvgErr = bSumErr / (STREAM_TYPE) STREAM_ARRAY_SIZE;
+	cAvgErr = cSumErr / (STREAM_TYPE) STREAM_ARRAY_SIZE;
+
+	if (sizeof(STREAM_TYPE) == 4) {
+		epsilon = 1.e-6;
+	}
+	else if (sizeof(STREAM_TYPE) == 8) {
+		epsilon = 1.e-13;
+	}
+	else {
+		printf("WEIRD: sizeof(STREAM_TYPE) = %lu\n",sizeof(STREAM_TYPE));
+		epsilon = 1.e-6;
+	}
+
+	err = 0;
+	if (abs(aAvgErr/aj) > epsilon) {
+		err++;
+		printf ("Failed Validation on array a[], AvgRelAbsErr > epsilon (%e)\n",epsilon);
+		printf ("     Expected Value: %e, AvgAbsErr: %e, AvgRelAbsErr: %e\n",aj,aAvgErr,abs(aAvgErr)/aj);
+		ierr = 0;
+		for (j=0; j<STREAM_ARRAY_SIZE; j++) {
+			if (abs(a[j]/aj-1.0) > epsilon) {
+				ierr++;
+			}
+		}
+		printf("     For array a[], %d errors were found.\n",ierr);
+	}
+	if (abs(bAvgErr/bj) > epsilon) {
+		err++;
+		printf ("Failed Validation on array b[], AvgRelAbsErr > epsilon (%e)\n",epsilon);
+		printf ("     Expected Value: %e, AvgAbsErr: %e, AvgRelAbsErr: %e\n",bj,bAvgErr,abs(bAvgErr)/bj);
+		ierr = 0;
+		for (j=0; j<STREAM_ARRAY_SIZE; j++) {
+			if (abs(b[j]/bj-1.0) > epsilon) {
+				ierr++;
+			}
+		}
+		printf("     For array b[], %d errors were found.\n",ierr);
+	}
+	if (abs(cAvgErr/cj) > epsilon) {
+		err++;
+		printf ("Failed Validation on array c[], AvgRelAbsErr > epsilon (%e)\n",epsilon);
+		printf ("     Expected Value: %e, AvgAbsErr: %e, AvgRelAbsErr: %e\n",cj,cAvgErr,abs(cAvgErr)/cj);
+		ierr = 0;
+		for (j=0; j<STREAM_ARRAY_SIZE; j++) {
+			if (abs(c[j]/cj-1.0) > epsilon) {
+				ierr++;
+			}
+		}
+		printf("     For array c[], %d errors were found.\n",ierr);
+	}
+	if (err == 0) {
+		printf ("Solution Validates: avg error less than %e on all three arrays\n",epsilon);
+	}
+}